@@ -0,0 +1,43 @@
+//
+//  Generics+Concurrency.m
+//  Generics
+//
+//  Copyright (c) 2012 Miso Media. All rights reserved.
+//
+
+#import "Generics+Executor.h"
+#import "GenericsBuffers.h"
+
+#if !__has_feature(objc_arc)
+#error Generics+Concurrency.m must be compiled with ARC (-fobjc-arc).
+#endif
+
+//	The images are written into a presized buffer by index, so the order of the preimage is kept however the iterations are scheduled.
+static NSArray* concurrentMapWithImageBlock(id(^imageBlock)(id x), NSArray* preimage)
+{
+	NSUInteger count;
+	__unsafe_unretained id* objects = newObjectsBuffer(preimage, nil, NO, &count);
+	__strong id* images = newResultsBuffer(count);
+	__block BOOL failed = NO;
+	concurrentApply(count, ^(size_t index){
+		if(!failed && !(images[index] = imageBlock(objects[index])))
+			failed = YES;
+	});
+	free(objects);
+	return arrayByConsumingResultsBuffer(images, count, failed);
+}
+
+NSArray* concurrentMap(id(^function)(id x), NSArray* preimage)
+{
+	return concurrentMapWithImageBlock(function, preimage);
+}
+
+NSArray* concurrentMapWithSelector(SEL selector, NSArray* preimage)
+{
+	return concurrentMapWithImageBlock(^id(id x){
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Warc-performSelector-leaks"
+		return [x performSelector:selector];
+#pragma clang diagnostic pop
+	}, preimage);
+}
@@ -0,0 +1,85 @@
+//
+//  Generics+Executor.h
+//  Generics
+//
+//  Copyright (c) 2012 Miso Media. All rights reserved.
+//
+
+#import <Generics/Generics.h>
+
+//!	\file	Every concurrent generic runs its iterations on a single, replaceable executor.
+/*!
+	By default that is a GenericsWorkStealingExecutor with one worker thread fewer than there are active processors, since the thread which calls a concurrent generic runs its iterations too.
+	A concurrent generic called from inside another one (say, a concurrentMap whose function calls concurrentMap) does not spawn new work: the nested call runs on the calling worker and leaves the rest of its iterations on that worker's deque for idle workers to steal.
+	To fit the library into an existing thread budget, pass your own executor (or a GenericsWorkStealingExecutor with a different thread count) to setGenericsExecutor.
+*/
+
+//!	The priority with which an executor should run a call's iterations.
+typedef enum
+{
+	GenericsExecutorPriorityHigh,
+	GenericsExecutorPriorityDefault,
+	GenericsExecutorPriorityLow,
+	GenericsExecutorPriorityBackground
+} GenericsExecutorPriority;
+
+//!	Something which runs the iterations of the concurrent generics.
+@protocol GenericsExecutor <NSObject>
+
+//!	Calls block once for each index in [0, iterations), possibly concurrently, and returns once every call has returned.  It must be safe to call this from inside block.
+-(void)applyIterations:(size_t)iterations priority:(GenericsExecutorPriority)priority block:(void(^)(size_t index))block;
+
+//!	The number of calls to block the executor can usefully run at once.  The concurrent generics cut their work into a few chunks per unit of parallelism.
+-(NSUInteger)parallelism;
+
+@end
+
+//!	An executor which hands every call to dispatch_apply on the global queue of matching priority.  Its parallelism is the number of active processors.
+@interface GenericsDispatchExecutor : NSObject <GenericsExecutor>
+
+@end
+
+//!	A fixed pool of worker threads, each with its own deque of work.
+/*!
+	A call from outside the pool queues its work by priority (higher priorities are always taken first), wakes the workers, and then works on its own iterations alongside them.
+	A call from one of the pool's workers pushes its work onto that worker's deque, where the worker finds it last in first out and idle workers steal it first in first out.
+	While a worker waits for the rest of its call to finish, it keeps running whatever other work it can find, and only sleeps when there is none.
+	The calling thread always takes part, so a call never waits on work that nobody is running.
+
+	Workers run a call's iterations at a thread priority matching the call's priority, and between chunks of iterations they check for newly queued work of a higher priority and run that first.
+	Work already on a worker's deque is not reordered, so a nested call runs at its enclosing call's pace.
+
+	The worker threads run until the executor is invalidated or deallocated, so an executor replaced by setGenericsExecutor lets its threads go once nothing else holds on to it.
+*/
+@interface GenericsWorkStealingExecutor : NSObject <GenericsExecutor>
+
+@property(nonatomic, readonly) NSUInteger threadCount;	//!<	The number of worker threads.  The executor's parallelism is one more, for the calling thread.
+
+-(id)init;	//!<	One worker thread fewer than there are active processors (but at least one), so that the workers and the calling thread together fill the processors.
+-(id)initWithThreadCount:(NSUInteger)threadCount;	//!<	The calling thread runs iterations too, so a call keeps up to threadCount + 1 threads busy.
+
+//!	Lets the worker threads exit once they finish the work they have already started.  Calls made afterwards run on the calling thread alone.
+-(void)invalidate;
+
+@end
+
+//!	Returns the executor the concurrent generics are using.
+id<GenericsExecutor> genericsExecutor(void);
+
+//!	Makes the concurrent generics use executor from now on.  Passing nil restores the default GenericsWorkStealingExecutor.
+/*!
+	The old executor is released; calls already running on it finish there.
+*/
+void setGenericsExecutor(id<GenericsExecutor> executor);
+
+//!	Returns the priority concurrent generics called on this thread will run with.  This is GenericsExecutorPriorityDefault unless set by performWithGenericsExecutorPriority or inherited from an enclosing concurrent generic.
+GenericsExecutorPriority currentGenericsExecutorPriority(void);
+
+//!	Calls block, running every concurrent generic it calls on this thread (and every concurrent generic nested inside those) with priority.
+void performWithGenericsExecutorPriority(GenericsExecutorPriority priority, void(^block)(void));
+
+//!	Calls block once for each index in [0, iterations) on the current executor, with the current priority, and returns once every call has returned.
+void concurrentApply(size_t iterations, void(^block)(size_t index));
+
+//!	The number of chunks a concurrent generic should cut count items into: a few per unit of the current executor's parallelism, but never shorter than minimumChunkLength, and at least one.
+NSUInteger concurrentChunkCount(NSUInteger count, NSUInteger minimumChunkLength);
@@ -0,0 +1,520 @@
+//
+//  Generics+Executor.m
+//  Generics
+//
+//  Copyright (c) 2012 Miso Media. All rights reserved.
+//
+
+#import "Generics+Executor.h"
+#import <pthread.h>
+
+#if !__has_feature(objc_arc)
+#error Generics+Executor.m must be compiled with ARC (-fobjc-arc).
+#endif
+
+#define priorityCount	(GenericsExecutorPriorityBackground + 1)
+
+//	Iterations are claimed this many chunks per worker at a time, so that uneven iterations still balance out.
+static const size_t chunksPerThread = 4;
+
+//	The NSThread priorities workers run each priority's iterations at.
+static const double threadPriorities[priorityCount] = {0.75, 0.5, 0.25, 0.0};
+
+#pragma mark	--thread state--
+
+static pthread_key_t priorityKey;
+static pthread_key_t workerKey;
+
+static void createThreadKeys(void)
+{
+	static dispatch_once_t once;
+	dispatch_once(&once, ^{
+		pthread_key_create(&priorityKey, NULL);
+		pthread_key_create(&workerKey, NULL);
+	});
+}
+
+//	The priority is stored off by one so that an unset key reads as the default.
+GenericsExecutorPriority currentGenericsExecutorPriority(void)
+{
+	createThreadKeys();
+	uintptr_t storedPriority = (uintptr_t)pthread_getspecific(priorityKey);
+	return storedPriority ? (GenericsExecutorPriority)(storedPriority - 1) : GenericsExecutorPriorityDefault;
+}
+
+void performWithGenericsExecutorPriority(GenericsExecutorPriority priority, void(^block)(void))
+{
+	createThreadKeys();
+	void* outerPriority = pthread_getspecific(priorityKey);
+	pthread_setspecific(priorityKey, (void*)(uintptr_t)(priority + 1));
+	block();
+	pthread_setspecific(priorityKey, outerPriority);
+}
+
+#pragma mark	--GenericsDispatchExecutor--
+
+@implementation GenericsDispatchExecutor
+
+-(void)applyIterations:(size_t)iterations priority:(GenericsExecutorPriority)priority block:(void(^)(size_t index))block
+{
+	static const long queuePriorities[priorityCount] = {DISPATCH_QUEUE_PRIORITY_HIGH, DISPATCH_QUEUE_PRIORITY_DEFAULT, DISPATCH_QUEUE_PRIORITY_LOW, DISPATCH_QUEUE_PRIORITY_BACKGROUND};
+	dispatch_apply(iterations, dispatch_get_global_queue(queuePriorities[priority], 0), ^(size_t index){
+		performWithGenericsExecutorPriority(priority, ^{
+			block(index);
+		});
+	});
+}
+
+-(NSUInteger)parallelism
+{
+	return [[NSProcessInfo processInfo] activeProcessorCount];
+}
+
+@end
+
+#pragma mark	--GenericsWorkStealingExecutor--
+
+@class GenericsWorker;
+
+//	One call to applyIterations:priority:block:.
+/*
+	The iterations are cut into chunks which are claimed with an atomic counter by whichever threads help: the caller, plus any worker which picks one of the job's tickets off a deque or the injection queues.
+	A ticket is just the job itself, so tickets picked up after every chunk has been claimed cost nothing.
+	The last chunk to complete broadcasts completion, which is the pool's own condition when the caller is a worker (so that it can wait for work and for the job at once) and a private one otherwise.
+*/
+@interface GenericsApplyJob : NSObject
+{
+	void(^block)(size_t index);
+	GenericsExecutorPriority priority;
+	size_t iterations;
+	size_t chunkLength;
+	size_t chunkCount;
+	volatile size_t nextChunk;
+	volatile size_t completedChunkCount;
+	NSCondition* completion;
+}
+
+@property(nonatomic, readonly) GenericsExecutorPriority priority;
+
+-(id)initWithIterations:(size_t)iterations chunkCount:(size_t)chunkCount priority:(GenericsExecutorPriority)priority completion:(NSCondition*)completion block:(void(^)(size_t index))block;
+-(BOOL)isFinished;
+-(void)helpWithWorker:(GenericsWorker*)worker;	//	Runs unclaimed chunks until there are none left.  worker is nil when the caller is not one of the pool's workers.
+-(void)waitUntilFinished;
+
+@end
+
+//	The threads, deques and queues behind a GenericsWorkStealingExecutor.
+/*
+	The workers hold on to the pool rather than to the executor, so the executor can be deallocated (which invalidates the pool) while they run.
+	Each worker lets go of the pool when its thread exits, and the pool goes once the last of them has.
+*/
+@interface GenericsWorkerPool : NSObject
+{
+	NSArray* workers;
+	NSMutableArray* injectedJobs[priorityCount];	//	tickets from callers outside the pool, by priority
+	volatile NSUInteger injectedJobCounts[priorityCount];	//	read without the lock between chunks, to see whether there is higher-priority work worth locking for
+	NSCondition* workAvailable;	//	guards injectedJobs and workGeneration
+	NSUInteger workGeneration;	//	bumped whenever tickets are queued anywhere, so that idle workers never miss a wakeup
+	volatile BOOL invalidated;
+}
+
+@property(nonatomic, strong, readonly) NSArray* workers;
+@property(nonatomic, strong, readonly) NSCondition* workAvailable;
+
+-(id)initWithThreadCount:(NSUInteger)threadCount;
+-(void)invalidate;
+-(BOOL)isInvalidated;
+
+-(NSUInteger)workGeneration;
+-(void)waitForWorkSinceGeneration:(NSUInteger)generation unlessFinished:(GenericsApplyJob*)job;
+-(void)queueJob:(GenericsApplyJob*)job count:(NSUInteger)count fromWorker:(GenericsWorker*)worker;
+-(GenericsApplyJob*)takeInjectedJobWithPriorityHigherThan:(NSUInteger)priority;
+-(GenericsApplyJob*)takeJobForWorker:(GenericsWorker*)worker;
+
+@end
+
+//	A worker thread and its deque.  The worker pushes and pops at the back; thieves steal from the front.
+@interface GenericsWorker : NSObject
+{
+	GenericsWorkerPool* pool;	//	cleared when the thread exits, breaking the cycle with the pool's workers
+	NSMutableArray* deque;
+	NSLock* dequeLock;
+}
+
+@property(nonatomic, strong, readonly) GenericsWorkerPool* pool;
+
+-(id)initWithPool:(GenericsWorkerPool*)pool;
+-(void)pushJob:(GenericsApplyJob*)job count:(NSUInteger)count;
+-(GenericsApplyJob*)popJob;
+-(GenericsApplyJob*)stealJob;
+-(void)helpUntilFinished:(GenericsApplyJob*)job;
+-(void)helpWithInjectedJobsOfPriorityHigherThan:(GenericsExecutorPriority)priority;
+
+@end
+
+@implementation GenericsApplyJob
+
+@synthesize priority;
+
+-(id)initWithIterations:(size_t)anIterations chunkCount:(size_t)aChunkCount priority:(GenericsExecutorPriority)aPriority completion:(NSCondition*)aCompletion block:(void(^)(size_t index))aBlock
+{
+	if((self = [super init]))
+	{
+		block = [aBlock copy];
+		priority = aPriority;
+		iterations = anIterations;
+		chunkLength = (anIterations + aChunkCount - 1) / aChunkCount;
+		chunkCount = (anIterations + chunkLength - 1) / chunkLength;
+		completion = aCompletion;
+	}
+	return self;
+}
+
+-(BOOL)isFinished
+{
+	BOOL finished = completedChunkCount == chunkCount;
+	//	Without this, armv7 may let the caller's reads of what the chunks wrote run ahead of this read of the counter.
+	__sync_synchronize();
+	return finished;
+}
+
+-(void)helpWithWorker:(GenericsWorker*)worker
+{
+	performWithGenericsExecutorPriority(priority, ^{
+		double outerThreadPriority = [NSThread threadPriority];
+		if(worker)
+			[NSThread setThreadPriority:threadPriorities[priority]];
+		size_t chunk;
+		while((chunk = __sync_fetch_and_add(&nextChunk, 1)) < chunkCount)
+		{
+			size_t end = MIN((chunk + 1) * chunkLength, iterations);
+			for(size_t index = chunk * chunkLength; index < end; ++index)
+				block(index);
+			if(__sync_add_and_fetch(&completedChunkCount, 1) == chunkCount)
+			{
+				[completion lock];
+				[completion broadcast];
+				[completion unlock];
+			}
+			[worker helpWithInjectedJobsOfPriorityHigherThan:priority];
+		}
+		if(worker)
+			[NSThread setThreadPriority:outerThreadPriority];
+	});
+}
+
+-(void)waitUntilFinished
+{
+	if([self isFinished])
+		return;
+	[completion lock];
+	while(![self isFinished])
+		[completion wait];
+	[completion unlock];
+}
+
+@end
+
+@implementation GenericsWorker
+
+@synthesize pool;
+
+-(id)initWithPool:(GenericsWorkerPool*)aPool
+{
+	if((self = [super init]))
+	{
+		pool = aPool;
+		deque = [NSMutableArray array];
+		dequeLock = [[NSLock alloc] init];
+	}
+	return self;
+}
+
+-(void)pushJob:(GenericsApplyJob*)job count:(NSUInteger)count
+{
+	[dequeLock lock];
+	for(NSUInteger i = 0; i < count; ++i)
+		[deque addObject:job];
+	[dequeLock unlock];
+}
+
+-(GenericsApplyJob*)popJob
+{
+	[dequeLock lock];
+	GenericsApplyJob* job = [deque lastObject];
+	if(job)
+		[deque removeLastObject];
+	[dequeLock unlock];
+	return job;
+}
+
+-(GenericsApplyJob*)stealJob
+{
+	[dequeLock lock];
+	GenericsApplyJob* job = [deque count] ? [deque objectAtIndex:0] : nil;
+	if(job)
+		[deque removeObjectAtIndex:0];
+	[dequeLock unlock];
+	return job;
+}
+
+//	Runs whatever work can be found until job has finished (or, if job is nil, until the pool is invalidated), sleeping only when there is none.
+-(void)helpUntilFinished:(GenericsApplyJob*)job
+{
+	while(job ? ![job isFinished] : ![pool isInvalidated])
+	{
+		@autoreleasepool
+		{
+			NSUInteger generation = [pool workGeneration];
+			GenericsApplyJob* nextJob = [self popJob];
+			if(!nextJob)
+				nextJob = [pool takeJobForWorker:self];
+			if(nextJob)
+				[nextJob helpWithWorker:self];
+			else
+				[pool waitForWorkSinceGeneration:generation unlessFinished:job];
+		}
+	}
+}
+
+-(void)helpWithInjectedJobsOfPriorityHigherThan:(GenericsExecutorPriority)priority
+{
+	GenericsApplyJob* job;
+	while((job = [pool takeInjectedJobWithPriorityHigherThan:priority]))
+		[job helpWithWorker:self];
+}
+
+-(void)run
+{
+	pthread_setspecific(workerKey, (__bridge void*)self);
+	[self helpUntilFinished:nil];
+	pthread_setspecific(workerKey, NULL);
+	pool = nil;
+}
+
+@end
+
+@implementation GenericsWorkerPool
+
+@synthesize workers, workAvailable;
+
+-(id)initWithThreadCount:(NSUInteger)threadCount
+{
+	if((self = [super init]))
+	{
+		createThreadKeys();
+		for(NSUInteger priority = 0; priority < priorityCount; ++priority)
+			injectedJobs[priority] = [NSMutableArray array];
+		workAvailable = [[NSCondition alloc] init];
+		NSMutableArray* newWorkers = [NSMutableArray arrayWithCapacity:MAX(threadCount, 1)];
+		for(NSUInteger i = 0; i < MAX(threadCount, 1); ++i)
+			[newWorkers addObject:[[GenericsWorker alloc] initWithPool:self]];
+		workers = newWorkers;
+		for(GenericsWorker* worker in workers)
+			[NSThread detachNewThreadSelector:@selector(run) toTarget:worker withObject:nil];
+	}
+	return self;
+}
+
+-(void)invalidate
+{
+	[workAvailable lock];
+	invalidated = YES;
+	++workGeneration;
+	[workAvailable broadcast];
+	[workAvailable unlock];
+}
+
+-(BOOL)isInvalidated
+{
+	return invalidated;
+}
+
+-(NSUInteger)workGeneration
+{
+	[workAvailable lock];
+	NSUInteger generation = workGeneration;
+	[workAvailable unlock];
+	return generation;
+}
+
+-(void)waitForWorkSinceGeneration:(NSUInteger)generation unlessFinished:(GenericsApplyJob*)job
+{
+	[workAvailable lock];
+	while(workGeneration == generation && ![job isFinished])
+		[workAvailable wait];
+	[workAvailable unlock];
+}
+
+//	Once the pool is invalidated nothing is queued, and the caller runs every chunk itself.
+-(void)queueJob:(GenericsApplyJob*)job count:(NSUInteger)count fromWorker:(GenericsWorker*)worker
+{
+	[workAvailable lock];
+	if(!invalidated)
+	{
+		if(worker)
+			[worker pushJob:job count:count];
+		else
+		{
+			for(NSUInteger i = 0; i < count; ++i)
+				[injectedJobs[job.priority] addObject:job];
+			injectedJobCounts[job.priority] += count;
+		}
+		++workGeneration;
+		[workAvailable broadcast];
+	}
+	[workAvailable unlock];
+}
+
+//	Lower priority values are higher priorities, so this takes the first ticket queued at a priority below priority, highest first.
+-(GenericsApplyJob*)takeInjectedJobWithPriorityHigherThan:(NSUInteger)priority
+{
+	NSUInteger candidate = 0;
+	while(candidate < priority && !injectedJobCounts[candidate])
+		++candidate;
+	if(candidate == priority)
+		return nil;
+
+	GenericsApplyJob* job = nil;
+	[workAvailable lock];
+	for(; candidate < priority && !job; ++candidate)
+	{
+		job = [injectedJobs[candidate] count] ? [injectedJobs[candidate] objectAtIndex:0] : nil;
+		if(job)
+		{
+			[injectedJobs[candidate] removeObjectAtIndex:0];
+			--injectedJobCounts[candidate];
+		}
+	}
+	[workAvailable unlock];
+	return job;
+}
+
+//	Injected tickets come first (highest priority first), then tickets stolen from the other workers, starting at a random one.
+-(GenericsApplyJob*)takeJobForWorker:(GenericsWorker*)worker
+{
+	GenericsApplyJob* job = [self takeInjectedJobWithPriorityHigherThan:priorityCount];
+	if(job)
+		return job;
+
+	NSUInteger workerCount = [workers count];
+	NSUInteger offset = arc4random_uniform((u_int32_t)workerCount);
+	for(NSUInteger i = 0; i < workerCount && !job; ++i)
+	{
+		GenericsWorker* victim = [workers objectAtIndex:(offset + i) % workerCount];
+		if(victim != worker)
+			job = [victim stealJob];
+	}
+	return job;
+}
+
+@end
+
+@implementation GenericsWorkStealingExecutor
+{
+	GenericsWorkerPool* pool;
+}
+
+//	The calling thread runs iterations too, so one processor is left for it.
+-(id)init
+{
+	NSUInteger processorCount = [[NSProcessInfo processInfo] activeProcessorCount];
+	return [self initWithThreadCount:MAX(processorCount, 2) - 1];
+}
+
+-(id)initWithThreadCount:(NSUInteger)threadCount
+{
+	if((self = [super init]))
+		pool = [[GenericsWorkerPool alloc] initWithThreadCount:threadCount];
+	return self;
+}
+
+-(void)dealloc
+{
+	[pool invalidate];
+}
+
+-(void)invalidate
+{
+	[pool invalidate];
+}
+
+-(NSUInteger)threadCount
+{
+	return [pool.workers count];
+}
+
+-(NSUInteger)parallelism
+{
+	return [pool.workers count] + 1;
+}
+
+-(void)applyIterations:(size_t)iterations priority:(GenericsExecutorPriority)priority block:(void(^)(size_t index))block
+{
+	if(!iterations)
+		return;
+	GenericsWorker* worker = (__bridge GenericsWorker*)pthread_getspecific(workerKey);
+	if(worker.pool != pool)
+		worker = nil;
+	NSUInteger workerCount = [pool.workers count];
+	NSCondition* completion = worker ? pool.workAvailable : [[NSCondition alloc] init];
+	GenericsApplyJob* job = [[GenericsApplyJob alloc] initWithIterations:iterations chunkCount:MIN(iterations, chunksPerThread * (workerCount + 1)) priority:priority completion:completion block:block];
+
+	//	The caller claims chunks too, so one ticket per worker is enough to get everyone involved.
+	NSUInteger ticketCount = MIN(iterations - 1, workerCount);
+	if(ticketCount)
+		[pool queueJob:job count:ticketCount fromWorker:worker];
+
+	[job helpWithWorker:worker];
+	if(worker)
+		[worker helpUntilFinished:job];
+	else
+		[job waitUntilFinished];
+}
+
+@end
+
+#pragma mark	--the current executor--
+
+static id<GenericsExecutor> currentExecutor = nil;	//	nil for the default one
+static pthread_mutex_t currentExecutorLock = PTHREAD_MUTEX_INITIALIZER;
+
+//	Created once, on first use, so that setting and resetting the executor never starts more threads.
+static id<GenericsExecutor> defaultExecutor(void)
+{
+	static id<GenericsExecutor> executor = nil;
+	static dispatch_once_t once;
+	dispatch_once(&once, ^{
+		executor = [[GenericsWorkStealingExecutor alloc] init];
+	});
+	return executor;
+}
+
+//	The executor is retained under the lock, so a concurrent setGenericsExecutor cannot free it out from under the caller.
+id<GenericsExecutor> genericsExecutor(void)
+{
+	pthread_mutex_lock(&currentExecutorLock);
+	id<GenericsExecutor> executor = currentExecutor;
+	pthread_mutex_unlock(&currentExecutorLock);
+	return executor ? executor : defaultExecutor();
+}
+
+//	The replaced executor is released after the lock is dropped; a GenericsWorkStealingExecutor lets its threads go once the calls still running on it return.
+void setGenericsExecutor(id<GenericsExecutor> executor)
+{
+	pthread_mutex_lock(&currentExecutorLock);
+	id<GenericsExecutor> replacedExecutor = currentExecutor;
+	currentExecutor = executor;
+	pthread_mutex_unlock(&currentExecutorLock);
+	replacedExecutor = nil;
+}
+
+void concurrentApply(size_t iterations, void(^block)(size_t index))
+{
+	[genericsExecutor() applyIterations:iterations priority:currentGenericsExecutorPriority() block:block];
+}
+
+NSUInteger concurrentChunkCount(NSUInteger count, NSUInteger minimumChunkLength)
+{
+	return MAX(MIN(count / minimumChunkLength, chunksPerThread * [genericsExecutor() parallelism]), 1);
+}
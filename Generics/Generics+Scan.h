@@ -0,0 +1,113 @@
+//
+//  Generics+Scan.h
+//  Generics
+//
+//  Copyright (c) 2012 Miso Media. All rights reserved.
+//
+
+#import <Generics/Generics.h>
+
+//!	A generic scanl function.
+/*!
+	scanl is like foldl, but it returns the list of successive reduced values from the left, beginning with the zero value.
+	The result has one more object than the list.  If the zero value is nil or the function returns nil for any pair, the whole thing is nil.
+
+	In Haskell:
+	\code
+	scanl            :: (a -> b -> a) -> a -> [b] -> [a]
+	scanl f q ls     =  q : (case ls of
+	                            []   -> []
+	                            x:xs -> scanl f (f q x) xs)
+	\endcode
+	\param	function	the functional argument as a variably typed function of two arguments of variable type using blocks.
+	\param	zero	the zero.
+	\param	list	the list as an NSArray*.
+*/
+NSArray* scanl(id(^function)(id lhs, id rhs), id zero, NSArray* list);
+
+//!	A generic scanl1 function.
+/*!
+	scanl1 is like scanl, but takes the head of the list as the zero value.  It returns an empty list for an empty list.
+
+	In Haskell:
+	\code
+	scanl1           :: (a -> a -> a) -> [a] -> [a]
+	scanl1 f (x:xs)  =  scanl f x xs
+	scanl1 _ []      =  []
+	\endcode
+	\param	function	the functional argument as a variably typed function of two arguments of variable type using blocks.
+	\param	list	the list as an NSArray*.
+*/
+NSArray* scanl1(id(^function)(id lhs, id rhs), NSArray* list);
+
+//!	A generic scanr function.
+/*!
+	scanr is the right-to-left dual of scanl: the head of the result is foldr applied to the same arguments and the last object is the zero value.
+	The result has one more object than the list.  If the zero value is nil or the function returns nil for any pair, the whole thing is nil.
+
+	In Haskell:
+	\code
+	scanr             :: (a -> b -> b) -> b -> [a] -> [b]
+	scanr _ q0 []     =  [q0]
+	scanr f q0 (x:xs) =  f x q : qs
+	                     where qs@(q:_) = scanr f q0 xs
+	\endcode
+	\param	function	the functional argument as a variably typed function of two arguments of variable type using blocks.
+	\param	zero	the zero.
+	\param	list	the list as an NSArray*.
+*/
+NSArray* scanr(id(^function)(id lhs, id rhs), id zero, NSArray* list);
+
+//!	A generic scanr1 function.
+/*!
+	scanr1 is like scanr, but takes the last object of the list as the zero value.  It returns an empty list for an empty list.
+
+	In Haskell:
+	\code
+	scanr1            :: (a -> a -> a) -> [a] -> [a]
+	scanr1 f []       =  []
+	scanr1 f [x]      =  [x]
+	scanr1 f (x:xs)   =  f x q : qs
+	                     where qs@(q:_) = scanr1 f xs
+	\endcode
+	\param	function	the functional argument as a variably typed function of two arguments of variable type using blocks.
+	\param	list	the list as an NSArray*.
+*/
+NSArray* scanr1(id(^function)(id lhs, id rhs), NSArray* list);
+
+#pragma mark	--Concurrency--
+
+//!	Assuming associativity of the input function, does the same thing as scanl, but does it concurrently.
+/*!
+	This is a two-pass (Blelloch-style) scan: the list is cut into chunks, each chunk is folded concurrently, the chunk totals are scanned serially, and then each chunk is scanned concurrently starting from the total of the chunks before it.
+	The function is applied roughly twice as many times as in scanl, so this only pays off for expensive functions or long lists on several cores.
+	The function need not be commutative, but the results are meaningless if it is not associative.
+*/
+NSArray* concurrentScanl(id(^function)(id lhs, id rhs), id zero, NSArray* list);
+
+//!	Assuming associativity of the input function, does the same thing as scanl1, but does it concurrently.
+NSArray* concurrentScanl1(id(^function)(id lhs, id rhs), NSArray* list);
+
+//!	Assuming associativity of the input function, does the same thing as scanr, but does it concurrently.
+NSArray* concurrentScanr(id(^function)(id lhs, id rhs), id zero, NSArray* list);
+
+//!	Assuming associativity of the input function, does the same thing as scanr1, but does it concurrently.
+NSArray* concurrentScanr1(id(^function)(id lhs, id rhs), NSArray* list);
+
+#pragma mark	--NSArray(Scan)--
+
+//!	A category on NSArray for the scans, alongside the folds in NSArray(Generics).
+@interface NSArray(Scan)
+
+//scan
++(NSArray*)scanlWithBlock:(id(^)(id lhs, id rhs))block zero:(id)zero overArray:(NSArray*)array;	//!<	This is scanl.
++(NSArray*)scanrWithBlock:(id(^)(id lhs, id rhs))block zero:(id)zero overArray:(NSArray*)array;	//!<	This is scanr.
++(NSArray*)scanl1WithBlock:(id(^)(id lhs, id rhs))block overArray:(NSArray*)array;	//!<	This is scanl1.
++(NSArray*)scanr1WithBlock:(id(^)(id lhs, id rhs))block overArray:(NSArray*)array;	//!<	This is scanr1.
+
+-(NSArray*)arrayByScanningLeftWithBlock:(id(^)(id a, id b))block zero:(id)zero;	//!<	This is per-instance scanl.
+-(NSArray*)arrayByScanningRightWithBlock:(id(^)(id a, id b))block zero:(id)zero;	//!<	This is per-instance scanr.
+-(NSArray*)arrayByScanningLeftWithBlock:(id(^)(id a, id b))block;	//!<	This is per-instance scanl1.
+-(NSArray*)arrayByScanningRightWithBlock:(id(^)(id a, id b))block;	//!<	This is per-instance scanr1.
+
+@end
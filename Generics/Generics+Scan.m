@@ -0,0 +1,237 @@
+//
+//  Generics+Scan.m
+//  Generics
+//
+//  Copyright (c) 2012 Miso Media. All rights reserved.
+//
+
+#import "Generics+Scan.h"
+#import "Generics+Executor.h"
+#import "GenericsBuffers.h"
+
+#if !__has_feature(objc_arc)
+#error Generics+Scan.m must be compiled with ARC (-fobjc-arc).
+#endif
+
+//	Every chunk but one is folded twice, so chunks need to be long enough for the extra pass to pay for itself.
+static const NSUInteger minimumScanChunkLength = 1024;
+
+#pragma mark	--serial--
+
+NSArray* scanl(id(^function)(id lhs, id rhs), id zero, NSArray* list)
+{
+	if(!zero)
+		return nil;
+	NSMutableArray* results = [NSMutableArray arrayWithCapacity:[list count] + 1];
+	id accumulator = zero;
+	[results addObject:accumulator];
+	for(id object in list)
+	{
+		accumulator = function(accumulator, object);
+		if(!accumulator)
+			return nil;
+		[results addObject:accumulator];
+	}
+	return results;
+}
+
+NSArray* scanl1(id(^function)(id lhs, id rhs), NSArray* list)
+{
+	if(![list count])
+		return [NSArray array];
+	return scanl(function, [list objectAtIndex:0], [list subarrayWithRange:NSMakeRange(1, [list count] - 1)]);
+}
+
+//	The serial suffix scan behind scanr and scanr1: results[i] = f(objects[i], results[i + 1]).
+static NSArray* serialSuffixScan(id(^function)(id lhs, id rhs), __unsafe_unretained id* objects, NSUInteger count)
+{
+	if(!count)
+		return [NSArray array];
+	__strong id* results = newResultsBuffer(count);
+	BOOL failed = NO;
+	id accumulator = objects[count - 1];
+	results[count - 1] = accumulator;
+	for(NSUInteger i = count - 1; i-- > 0;)
+	{
+		accumulator = function(objects[i], accumulator);
+		if(!accumulator)
+		{
+			failed = YES;
+			break;
+		}
+		results[i] = accumulator;
+	}
+	return arrayByConsumingResultsBuffer(results, count, failed);
+}
+
+NSArray* scanr(id(^function)(id lhs, id rhs), id zero, NSArray* list)
+{
+	if(!zero)
+		return nil;
+	NSUInteger count;
+	__unsafe_unretained id* objects = newObjectsBuffer(list, zero, NO, &count);
+	NSArray* results = serialSuffixScan(function, objects, count);
+	free(objects);
+	return results;
+}
+
+NSArray* scanr1(id(^function)(id lhs, id rhs), NSArray* list)
+{
+	NSUInteger count;
+	__unsafe_unretained id* objects = newObjectsBuffer(list, nil, NO, &count);
+	NSArray* results = serialSuffixScan(function, objects, count);
+	free(objects);
+	return results;
+}
+
+#pragma mark	--concurrent--
+
+//	Two-pass scan over chunks of objects.
+/*
+	Pass one folds every chunk but the last (for a prefix scan) or the first (for a suffix scan) concurrently.
+	The chunk totals are then scanned serially to get the carry into each chunk.
+	Pass two scans every chunk concurrently, starting from its carry.
+	For a suffix scan the chunks are walked right to left and the accumulator is the right argument of the function.
+*/
+static NSArray* concurrentScan(id(^function)(id lhs, id rhs), __unsafe_unretained id* objects, NSUInteger count, BOOL suffix)
+{
+	if(!count)
+		return [NSArray array];
+	NSUInteger chunkCount = concurrentChunkCount(count, minimumScanChunkLength);
+	NSUInteger chunkLength = (count + chunkCount - 1) / chunkCount;
+	chunkCount = (count + chunkLength - 1) / chunkLength;
+
+	__strong id* results = newResultsBuffer(count);
+	__strong id* carries = newResultsBuffer(chunkCount);
+	__block BOOL failed = NO;
+
+	//	Folds (or, if store is set, scans) chunk starting from carry.  Returns the chunk total, or nil on failure.
+	id(^scanChunk)(NSUInteger chunk, id carry, BOOL store) = ^id(NSUInteger chunk, id carry, BOOL store){
+		NSUInteger begin = chunk * chunkLength;
+		NSUInteger end = MIN(begin + chunkLength, count);
+		id accumulator = carry;
+		for(NSUInteger step = begin; step < end && !failed; ++step)
+		{
+			NSUInteger i = suffix ? count - 1 - step : step;
+			if(!accumulator)
+				accumulator = objects[i];
+			else
+				accumulator = suffix ? function(objects[i], accumulator) : function(accumulator, objects[i]);
+			if(!accumulator)
+			{
+				failed = YES;
+				return nil;
+			}
+			if(store)
+				results[i] = accumulator;
+		}
+		return accumulator;
+	};
+
+	if(chunkCount > 1)
+	{
+		concurrentApply(chunkCount - 1, ^(size_t chunk){
+			carries[chunk + 1] = scanChunk(chunk, nil, NO);
+		});
+		//	carries[c] now holds the total of chunk c - 1; turn it into the total of chunks 0 ... c - 1.
+		for(NSUInteger chunk = 2; chunk < chunkCount && !failed; ++chunk)
+		{
+			carries[chunk] = suffix ? function(carries[chunk], carries[chunk - 1]) : function(carries[chunk - 1], carries[chunk]);
+			if(!carries[chunk])
+				failed = YES;
+		}
+	}
+	if(!failed)
+		concurrentApply(chunkCount, ^(size_t chunk){
+			scanChunk(chunk, carries[chunk], YES);
+		});
+
+	freeResultsBuffer(carries, chunkCount);
+	return arrayByConsumingResultsBuffer(results, count, failed);
+}
+
+NSArray* concurrentScanl(id(^function)(id lhs, id rhs), id zero, NSArray* list)
+{
+	if(!zero)
+		return nil;
+	NSUInteger count;
+	__unsafe_unretained id* objects = newObjectsBuffer(list, zero, YES, &count);
+	NSArray* results = concurrentScan(function, objects, count, NO);
+	free(objects);
+	return results;
+}
+
+NSArray* concurrentScanl1(id(^function)(id lhs, id rhs), NSArray* list)
+{
+	NSUInteger count;
+	__unsafe_unretained id* objects = newObjectsBuffer(list, nil, YES, &count);
+	NSArray* results = concurrentScan(function, objects, count, NO);
+	free(objects);
+	return results;
+}
+
+NSArray* concurrentScanr(id(^function)(id lhs, id rhs), id zero, NSArray* list)
+{
+	if(!zero)
+		return nil;
+	NSUInteger count;
+	__unsafe_unretained id* objects = newObjectsBuffer(list, zero, NO, &count);
+	NSArray* results = concurrentScan(function, objects, count, YES);
+	free(objects);
+	return results;
+}
+
+NSArray* concurrentScanr1(id(^function)(id lhs, id rhs), NSArray* list)
+{
+	NSUInteger count;
+	__unsafe_unretained id* objects = newObjectsBuffer(list, nil, NO, &count);
+	NSArray* results = concurrentScan(function, objects, count, YES);
+	free(objects);
+	return results;
+}
+
+#pragma mark	--NSArray(Scan)--
+
+@implementation NSArray(Scan)
+
++(NSArray*)scanlWithBlock:(id(^)(id lhs, id rhs))block zero:(id)zero overArray:(NSArray*)array
+{
+	return scanl(block, zero, array);
+}
+
++(NSArray*)scanrWithBlock:(id(^)(id lhs, id rhs))block zero:(id)zero overArray:(NSArray*)array
+{
+	return scanr(block, zero, array);
+}
+
++(NSArray*)scanl1WithBlock:(id(^)(id lhs, id rhs))block overArray:(NSArray*)array
+{
+	return scanl1(block, array);
+}
+
++(NSArray*)scanr1WithBlock:(id(^)(id lhs, id rhs))block overArray:(NSArray*)array
+{
+	return scanr1(block, array);
+}
+
+-(NSArray*)arrayByScanningLeftWithBlock:(id(^)(id a, id b))block zero:(id)zero
+{
+	return scanl(block, zero, self);
+}
+
+-(NSArray*)arrayByScanningRightWithBlock:(id(^)(id a, id b))block zero:(id)zero
+{
+	return scanr(block, zero, self);
+}
+
+-(NSArray*)arrayByScanningLeftWithBlock:(id(^)(id a, id b))block
+{
+	return scanl1(block, self);
+}
+
+-(NSArray*)arrayByScanningRightWithBlock:(id(^)(id a, id b))block
+{
+	return scanr1(block, self);
+}
+
+@end
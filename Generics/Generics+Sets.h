@@ -0,0 +1,126 @@
+//
+//  Generics+Sets.h
+//  Generics
+//
+//  Copyright (c) 2012 Miso Media. All rights reserved.
+//
+
+#import <Generics/Generics.h>
+
+//!	A generic nub function.
+/*!
+	nub takes a list and returns the list with every object after the first equal (isEqual:) one removed, keeping the order of the survivors.
+	It runs in linear time by remembering the objects it has seen in a hash set, so the objects must honour the isEqual:/hash contract.
+
+	In Haskell:
+	\code
+	nub              :: (Eq a) => [a] -> [a]
+	nub              =  nubBy (==)
+	\endcode
+	\param	list	the list as an NSArray*.
+*/
+NSArray* nub(NSArray* list);
+
+//!	A generic nubBy function, with a projection in place of an equality.
+/*!
+	nubBy keeps the first object in the list with each projection, in order.  The projections are hashed, so they must honour the isEqual:/hash contract.
+	If the projection block returns nil for any object, the whole thing is nil.
+
+	In Haskell:
+	\code
+	nubBy ((==) `on` projection)
+	\endcode
+	\param	projectionBlock	the projection as a variably typed function of a single argument of variable type using blocks.
+	\param	list	the list as an NSArray*.
+*/
+NSArray* nubBy(id(^projectionBlock)(id x), NSArray* list);
+
+//!	A generic union function (union is a C keyword, hence the name).
+/*!
+	unionObjects returns the first list followed by the objects of the second list which are not in the first list (and not repeated in the second list).
+	Duplicates in the first list are kept.
+
+	In Haskell:
+	\code
+	union            :: (Eq a) => [a] -> [a] -> [a]
+	union xs ys      =  xs ++ foldl (flip delete) (nub ys) xs
+	\endcode
+	\param	lhsList	the first list as an NSArray*.
+	\param	rhsList	the second list as an NSArray*.
+*/
+NSArray* unionObjects(NSArray* lhsList, NSArray* rhsList);
+
+//!	A generic intersect function.
+/*!
+	intersectObjects returns the objects of the first list which are also in the second list, in order.  Duplicates in the first list are kept.
+
+	In Haskell:
+	\code
+	intersect        :: (Eq a) => [a] -> [a] -> [a]
+	intersect xs ys  =  [x | x <- xs, x `elem` ys]
+	\endcode
+	\param	lhsList	the first list as an NSArray*.
+	\param	rhsList	the second list as an NSArray*.
+*/
+NSArray* intersectObjects(NSArray* lhsList, NSArray* rhsList);
+
+//!	A generic list difference function.
+/*!
+	differenceObjects removes from the first list the first occurrence of each object of the second list (so it respects multiplicity), keeping the order of the survivors.
+
+	In Haskell:
+	\code
+	(\\)             :: (Eq a) => [a] -> [a] -> [a]
+	(\\)             =  foldl (flip delete)
+	\endcode
+	\param	lhsList	the list to remove objects from as an NSArray*.
+	\param	rhsList	the objects to remove as an NSArray*.
+*/
+NSArray* differenceObjects(NSArray* lhsList, NSArray* rhsList);
+
+//!	The same as mergeDictionariesAppendArraysUniteSets, except that every array in the result is nubbed (so each object appears once, at its first position) and sets need not be disjoint.
+/*!
+	Arrays are nubbed whether they were appended or come from only one side, and so are the arrays inside dictionaries which come from only one side, so the result does not depend on which keys collide.
+	Merging {} with {events: [a, a]} gives {events: [a]}, just as merging {events: []} with it does.
+*/
+id mergeDictionariesAppendArraysUniquelyUniteSets(id lhs, id rhs);
+
+#pragma mark	--Concurrency--
+
+//!	Does the same thing as nub, but does it concurrently.
+/*!
+	The objects are partitioned by hash, so that equal objects always land in the same partition, and each partition is nubbed concurrently against its own hash set.
+	Only worth it for long lists; short ones are nubbed serially.
+*/
+NSArray* concurrentNub(NSArray* list);
+
+//!	Assuming referential transparency of the projection block, does the same thing as nubBy, but does it concurrently.
+NSArray* concurrentNubBy(id(^projectionBlock)(id x), NSArray* list);
+
+//!	Does the same thing as unionObjects, but does it concurrently, partitioning both lists by hash as concurrentNub does.
+NSArray* concurrentUnionObjects(NSArray* lhsList, NSArray* rhsList);
+
+//!	Does the same thing as intersectObjects, but does it concurrently, partitioning both lists by hash as concurrentNub does.
+NSArray* concurrentIntersectObjects(NSArray* lhsList, NSArray* rhsList);
+
+//!	Does the same thing as differenceObjects, but does it concurrently, partitioning both lists by hash as concurrentNub does.
+NSArray* concurrentDifferenceObjects(NSArray* lhsList, NSArray* rhsList);
+
+#pragma mark	--NSArray(Sets)--
+
+//!	A category on NSArray for the hash-based list set operations.
+@interface NSArray(Sets)
+
++(NSArray*)nubArray:(NSArray*)array;	//!<	This is nub.
++(NSArray*)nubWithProjectionBlock:(id(^)(id x))block overArray:(NSArray*)array;	//!<	This is nubBy.
++(NSArray*)unionOfArray:(NSArray*)lhsArray withArray:(NSArray*)rhsArray;	//!<	This is unionObjects.
++(NSArray*)intersectionOfArray:(NSArray*)lhsArray withArray:(NSArray*)rhsArray;	//!<	This is intersectObjects.
++(NSArray*)differenceOfArray:(NSArray*)lhsArray withArray:(NSArray*)rhsArray;	//!<	This is differenceObjects.
+
+-(NSArray*)nubbedArray;	//!<	This is per-instance nub.
+-(NSArray*)arrayByNubbingWithProjectionBlock:(id(^)(id x))block;	//!<	This is per-instance nubBy.
+-(NSArray*)arrayByUnitingWithArray:(NSArray*)array;	//!<	This is per-instance unionObjects.
+-(NSArray*)arrayByIntersectingWithArray:(NSArray*)array;	//!<	This is per-instance intersectObjects.
+-(NSArray*)arrayByRemovingObjectsInArray:(NSArray*)array;	//!<	This is per-instance differenceObjects.
+
+@end
@@ -0,0 +1,414 @@
+//
+//  Generics+Sets.m
+//  Generics
+//
+//  Copyright (c) 2012 Miso Media. All rights reserved.
+//
+
+#import "Generics+Sets.h"
+#import "Generics+Executor.h"
+#import "GenericsBuffers.h"
+
+#if !__has_feature(objc_arc)
+#error Generics+Sets.m must be compiled with ARC (-fobjc-arc).
+#endif
+
+//	Each partition builds its own hash set, so small partitions would spend more on set setup than they save.
+static const NSUInteger minimumHashPartitionLength = 4096;
+
+//	Appends to results the objects of list which are not yet in seen, adding them to seen.
+//	Checking the count of seen around addObject: costs one hash lookup per object instead of two.
+static void appendUnseenObjects(NSMutableArray* results, NSMutableSet* seen, NSArray* list)
+{
+	for(id object in list)
+	{
+		NSUInteger seenCount = [seen count];
+		[seen addObject:object];
+		if([seen count] != seenCount)
+			[results addObject:object];
+	}
+}
+
+#pragma mark	--serial--
+
+NSArray* nub(NSArray* list)
+{
+	NSMutableArray* results = [NSMutableArray arrayWithCapacity:[list count]];
+	appendUnseenObjects(results, [NSMutableSet setWithCapacity:[list count]], list);
+	return results;
+}
+
+NSArray* nubBy(id(^projectionBlock)(id x), NSArray* list)
+{
+	NSMutableArray* results = [NSMutableArray arrayWithCapacity:[list count]];
+	NSMutableSet* seen = [NSMutableSet setWithCapacity:[list count]];
+	for(id object in list)
+	{
+		id projection = projectionBlock(object);
+		if(!projection)
+			return nil;
+		NSUInteger seenCount = [seen count];
+		[seen addObject:projection];
+		if([seen count] != seenCount)
+			[results addObject:object];
+	}
+	return results;
+}
+
+NSArray* unionObjects(NSArray* lhsList, NSArray* rhsList)
+{
+	NSMutableArray* results = [NSMutableArray arrayWithCapacity:[lhsList count] + [rhsList count]];
+	[results addObjectsFromArray:lhsList];
+	NSMutableSet* seen = [NSMutableSet setWithArray:lhsList];
+	appendUnseenObjects(results, seen, rhsList);
+	return results;
+}
+
+NSArray* intersectObjects(NSArray* lhsList, NSArray* rhsList)
+{
+	NSSet* rhsSet = [NSSet setWithArray:rhsList];
+	NSMutableArray* results = [NSMutableArray arrayWithCapacity:MIN([lhsList count], [rhsList count])];
+	for(id object in lhsList)
+		if([rhsSet containsObject:object])
+			[results addObject:object];
+	return results;
+}
+
+NSArray* differenceObjects(NSArray* lhsList, NSArray* rhsList)
+{
+	NSCountedSet* remaining = [[NSCountedSet alloc] initWithArray:rhsList];
+	NSMutableArray* results = [NSMutableArray arrayWithCapacity:[lhsList count]];
+	for(id object in lhsList)
+	{
+		//	removeObject: on a counted set only decrements the count.
+		if([remaining countForObject:object])
+			[remaining removeObject:object];
+		else
+			[results addObject:object];
+	}
+	return results;
+}
+
+//	Nubs object if it is an array, and every array inside it if it is a dictionary, so that merging gives the same result whether or not keys collide.
+static id nubArraysInObject(id object)
+{
+	if([object isKindOfClass:[NSArray class]])
+		return nub(object);
+	if([object isKindOfClass:[NSDictionary class]])
+	{
+		NSMutableDictionary* nubbed = [NSMutableDictionary dictionaryWithCapacity:[object count]];
+		for(id key in object)
+			[nubbed setObject:nubArraysInObject([object objectForKey:key]) forKey:key];
+		return nubbed;
+	}
+	return object;
+}
+
+id mergeDictionariesAppendArraysUniquelyUniteSets(id lhs, id rhs)
+{
+	if([lhs isKindOfClass:[NSDictionary class]] && [rhs isKindOfClass:[NSDictionary class]])
+	{
+		NSMutableDictionary* merged = nubArraysInObject(lhs);
+		for(id key in rhs)
+		{
+			id rhsObject = [rhs objectForKey:key];
+			id lhsObject = [lhs objectForKey:key];
+			id object = lhsObject ? mergeDictionariesAppendArraysUniquelyUniteSets(lhsObject, rhsObject) : nubArraysInObject(rhsObject);
+			if(!object)
+				return nil;
+			[merged setObject:object forKey:key];
+		}
+		return merged;
+	}
+	if([lhs isKindOfClass:[NSArray class]] && [rhs isKindOfClass:[NSArray class]])
+	{
+		NSMutableArray* results = [NSMutableArray arrayWithCapacity:[lhs count] + [rhs count]];
+		NSMutableSet* seen = [NSMutableSet setWithCapacity:[lhs count] + [rhs count]];
+		appendUnseenObjects(results, seen, lhs);
+		appendUnseenObjects(results, seen, rhs);
+		return results;
+	}
+	if([lhs isKindOfClass:[NSSet class]] && [rhs isKindOfClass:[NSSet class]])
+		return [lhs setByAddingObjectsFromSet:rhs];
+	return nil;
+}
+
+#pragma mark	--concurrent--
+
+//	NSNumber and friends hash to small consecutive values, so scramble the hash before taking the remainder.
+static NSUInteger partitionOfHash(NSUInteger hash, NSUInteger partitionCount)
+{
+	return (NSUInteger)(((uint64_t)hash * 0x9E3779B97F4A7C15ull) >> 32) % partitionCount;
+}
+
+//	Calls block on consecutive ranges of [0, count) concurrently, one range per partition.
+static void applyToRanges(NSUInteger count, NSUInteger partitionCount, void(^block)(NSUInteger begin, NSUInteger end))
+{
+	NSUInteger rangeLength = (count + partitionCount - 1) / partitionCount;
+	concurrentApply(partitionCount, ^(size_t partition){
+		NSUInteger begin = partition * rangeLength;
+		if(begin < count)
+			block(begin, MIN(begin + rangeLength, count));
+	});
+}
+
+//	The indexes of a list bucketed by the hash of their keys: partition p holds indexes[offsets[p]] ... indexes[offsets[p + 1] - 1], in increasing order.
+/*
+	Equal keys have equal hashes, so they always land in the same partition, and partitions can be worked on concurrently, each against its own hash set, without locking.
+	The bucketing is a counting sort, which keeps the indexes in order within each partition, so order-sensitive operations (the first occurrence wins) behave just as they do serially.
+*/
+typedef struct
+{
+	NSUInteger* offsets;
+	NSUInteger* indexes;
+} GenericsHashPartitions;
+
+//	keys may be NULL, in which case the objects are their own keys.
+static GenericsHashPartitions newHashPartitions(__unsafe_unretained id* objects, __strong id* keys, NSUInteger count, NSUInteger partitionCount)
+{
+	NSUInteger* partitions = (NSUInteger*)malloc((count ? count : 1) * sizeof(NSUInteger));
+	applyToRanges(count, partitionCount, ^(NSUInteger begin, NSUInteger end){
+		for(NSUInteger i = begin; i < end; ++i)
+			partitions[i] = partitionOfHash([(keys ? keys[i] : objects[i]) hash], partitionCount);
+	});
+
+	GenericsHashPartitions hashPartitions;
+	hashPartitions.offsets = (NSUInteger*)calloc(partitionCount + 1, sizeof(NSUInteger));
+	for(NSUInteger i = 0; i < count; ++i)
+		++hashPartitions.offsets[partitions[i] + 1];
+	for(NSUInteger partition = 0; partition < partitionCount; ++partition)
+		hashPartitions.offsets[partition + 1] += hashPartitions.offsets[partition];
+	hashPartitions.indexes = (NSUInteger*)malloc((count ? count : 1) * sizeof(NSUInteger));
+	NSUInteger* cursors = (NSUInteger*)malloc(partitionCount * sizeof(NSUInteger));
+	memcpy(cursors, hashPartitions.offsets, partitionCount * sizeof(NSUInteger));
+	for(NSUInteger i = 0; i < count; ++i)
+		hashPartitions.indexes[cursors[partitions[i]]++] = i;
+	free(cursors);
+	free(partitions);
+	return hashPartitions;
+}
+
+static void freeHashPartitions(GenericsHashPartitions hashPartitions)
+{
+	free(hashPartitions.offsets);
+	free(hashPartitions.indexes);
+}
+
+//	Appends to results the objects whose keep flag is set, in order.
+static void appendKeptObjects(NSMutableArray* results, __unsafe_unretained id* objects, bool* keep, NSUInteger count)
+{
+	for(NSUInteger i = 0; i < count; ++i)
+		if(keep[i])
+			[results addObject:objects[i]];
+}
+
+static NSArray* concurrentNubWithKeys(__unsafe_unretained id* objects, __strong id* keys, NSUInteger count, NSUInteger partitionCount)
+{
+	GenericsHashPartitions hashPartitions = newHashPartitions(objects, keys, count, partitionCount);
+	bool* keep = (bool*)calloc(count, sizeof(bool));
+	concurrentApply(partitionCount, ^(size_t partition){
+		NSUInteger begin = hashPartitions.offsets[partition];
+		NSUInteger end = hashPartitions.offsets[partition + 1];
+		NSMutableSet* seen = [NSMutableSet setWithCapacity:end - begin];
+		for(NSUInteger k = begin; k < end; ++k)
+		{
+			NSUInteger i = hashPartitions.indexes[k];
+			NSUInteger seenCount = [seen count];
+			[seen addObject:keys ? keys[i] : objects[i]];
+			keep[i] = [seen count] != seenCount;
+		}
+	});
+	freeHashPartitions(hashPartitions);
+
+	NSMutableArray* results = [NSMutableArray arrayWithCapacity:count];
+	appendKeptObjects(results, objects, keep, count);
+	free(keep);
+	return results;
+}
+
+NSArray* concurrentNub(NSArray* list)
+{
+	NSUInteger count = [list count];
+	NSUInteger partitionCount = concurrentChunkCount(count, minimumHashPartitionLength);
+	if(partitionCount < 2)
+		return nub(list);
+	__unsafe_unretained id* objects = newObjectsBuffer(list, nil, NO, &count);
+	NSArray* results = concurrentNubWithKeys(objects, NULL, count, partitionCount);
+	free(objects);
+	return results;
+}
+
+NSArray* concurrentNubBy(id(^projectionBlock)(id x), NSArray* list)
+{
+	NSUInteger count = [list count];
+	NSUInteger partitionCount = concurrentChunkCount(count, minimumHashPartitionLength);
+	if(partitionCount < 2)
+		return nubBy(projectionBlock, list);
+	__unsafe_unretained id* objects = newObjectsBuffer(list, nil, NO, &count);
+	__strong id* projections = newResultsBuffer(count);
+	__block BOOL failed = NO;
+	applyToRanges(count, partitionCount, ^(NSUInteger begin, NSUInteger end){
+		for(NSUInteger i = begin; i < end && !failed; ++i)
+			if(!(projections[i] = projectionBlock(objects[i])))
+				failed = YES;
+	});
+	NSArray* results = failed ? nil : concurrentNubWithKeys(objects, projections, count, partitionCount);
+	freeResultsBuffer(projections, count);
+	free(objects);
+	return results;
+}
+
+//	Partitions both lists by hash with the same partition count and calls block concurrently on each partition.
+//	block sets keep flags for lhs objects or rhs objects, whichever the operation keeps.
+static void applyToPairedHashPartitions(__unsafe_unretained id* lhsObjects, NSUInteger lhsCount, __unsafe_unretained id* rhsObjects, NSUInteger rhsCount, NSUInteger partitionCount, void(^block)(NSUInteger* lhsIndexes, NSUInteger lhsPartitionCount, NSUInteger* rhsIndexes, NSUInteger rhsPartitionCount))
+{
+	GenericsHashPartitions lhsPartitions = newHashPartitions(lhsObjects, NULL, lhsCount, partitionCount);
+	GenericsHashPartitions rhsPartitions = newHashPartitions(rhsObjects, NULL, rhsCount, partitionCount);
+	concurrentApply(partitionCount, ^(size_t partition){
+		NSUInteger lhsBegin = lhsPartitions.offsets[partition];
+		NSUInteger rhsBegin = rhsPartitions.offsets[partition];
+		block(lhsPartitions.indexes + lhsBegin, lhsPartitions.offsets[partition + 1] - lhsBegin, rhsPartitions.indexes + rhsBegin, rhsPartitions.offsets[partition + 1] - rhsBegin);
+	});
+	freeHashPartitions(lhsPartitions);
+	freeHashPartitions(rhsPartitions);
+}
+
+NSArray* concurrentUnionObjects(NSArray* lhsList, NSArray* rhsList)
+{
+	NSUInteger partitionCount = concurrentChunkCount([lhsList count] + [rhsList count], minimumHashPartitionLength);
+	if(partitionCount < 2)
+		return unionObjects(lhsList, rhsList);
+	NSUInteger lhsCount, rhsCount;
+	__unsafe_unretained id* lhsObjects = newObjectsBuffer(lhsList, nil, NO, &lhsCount);
+	__unsafe_unretained id* rhsObjects = newObjectsBuffer(rhsList, nil, NO, &rhsCount);
+	bool* keep = (bool*)calloc(rhsCount ? rhsCount : 1, sizeof(bool));
+	applyToPairedHashPartitions(lhsObjects, lhsCount, rhsObjects, rhsCount, partitionCount, ^(NSUInteger* lhsIndexes, NSUInteger lhsPartitionCount, NSUInteger* rhsIndexes, NSUInteger rhsPartitionCount){
+		NSMutableSet* seen = [NSMutableSet setWithCapacity:lhsPartitionCount + rhsPartitionCount];
+		for(NSUInteger k = 0; k < lhsPartitionCount; ++k)
+			[seen addObject:lhsObjects[lhsIndexes[k]]];
+		for(NSUInteger k = 0; k < rhsPartitionCount; ++k)
+		{
+			NSUInteger i = rhsIndexes[k];
+			NSUInteger seenCount = [seen count];
+			[seen addObject:rhsObjects[i]];
+			keep[i] = [seen count] != seenCount;
+		}
+	});
+	NSMutableArray* results = [NSMutableArray arrayWithCapacity:lhsCount + rhsCount];
+	[results addObjectsFromArray:lhsList];
+	appendKeptObjects(results, rhsObjects, keep, rhsCount);
+	free(keep);
+	free(rhsObjects);
+	free(lhsObjects);
+	return results;
+}
+
+NSArray* concurrentIntersectObjects(NSArray* lhsList, NSArray* rhsList)
+{
+	NSUInteger partitionCount = concurrentChunkCount([lhsList count] + [rhsList count], minimumHashPartitionLength);
+	if(partitionCount < 2)
+		return intersectObjects(lhsList, rhsList);
+	NSUInteger lhsCount, rhsCount;
+	__unsafe_unretained id* lhsObjects = newObjectsBuffer(lhsList, nil, NO, &lhsCount);
+	__unsafe_unretained id* rhsObjects = newObjectsBuffer(rhsList, nil, NO, &rhsCount);
+	bool* keep = (bool*)calloc(lhsCount ? lhsCount : 1, sizeof(bool));
+	applyToPairedHashPartitions(lhsObjects, lhsCount, rhsObjects, rhsCount, partitionCount, ^(NSUInteger* lhsIndexes, NSUInteger lhsPartitionCount, NSUInteger* rhsIndexes, NSUInteger rhsPartitionCount){
+		NSMutableSet* rhsSet = [NSMutableSet setWithCapacity:rhsPartitionCount];
+		for(NSUInteger k = 0; k < rhsPartitionCount; ++k)
+			[rhsSet addObject:rhsObjects[rhsIndexes[k]]];
+		for(NSUInteger k = 0; k < lhsPartitionCount; ++k)
+			keep[lhsIndexes[k]] = [rhsSet containsObject:lhsObjects[lhsIndexes[k]]];
+	});
+	NSMutableArray* results = [NSMutableArray arrayWithCapacity:lhsCount];
+	appendKeptObjects(results, lhsObjects, keep, lhsCount);
+	free(keep);
+	free(rhsObjects);
+	free(lhsObjects);
+	return results;
+}
+
+NSArray* concurrentDifferenceObjects(NSArray* lhsList, NSArray* rhsList)
+{
+	NSUInteger partitionCount = concurrentChunkCount([lhsList count] + [rhsList count], minimumHashPartitionLength);
+	if(partitionCount < 2)
+		return differenceObjects(lhsList, rhsList);
+	NSUInteger lhsCount, rhsCount;
+	__unsafe_unretained id* lhsObjects = newObjectsBuffer(lhsList, nil, NO, &lhsCount);
+	__unsafe_unretained id* rhsObjects = newObjectsBuffer(rhsList, nil, NO, &rhsCount);
+	bool* keep = (bool*)calloc(lhsCount ? lhsCount : 1, sizeof(bool));
+	applyToPairedHashPartitions(lhsObjects, lhsCount, rhsObjects, rhsCount, partitionCount, ^(NSUInteger* lhsIndexes, NSUInteger lhsPartitionCount, NSUInteger* rhsIndexes, NSUInteger rhsPartitionCount){
+		NSCountedSet* remaining = [[NSCountedSet alloc] initWithCapacity:rhsPartitionCount];
+		for(NSUInteger k = 0; k < rhsPartitionCount; ++k)
+			[remaining addObject:rhsObjects[rhsIndexes[k]]];
+		for(NSUInteger k = 0; k < lhsPartitionCount; ++k)
+		{
+			id object = lhsObjects[lhsIndexes[k]];
+			if([remaining countForObject:object])
+				[remaining removeObject:object];
+			else
+				keep[lhsIndexes[k]] = true;
+		}
+	});
+	NSMutableArray* results = [NSMutableArray arrayWithCapacity:lhsCount];
+	appendKeptObjects(results, lhsObjects, keep, lhsCount);
+	free(keep);
+	free(rhsObjects);
+	free(lhsObjects);
+	return results;
+}
+
+#pragma mark	--NSArray(Sets)--
+
+@implementation NSArray(Sets)
+
++(NSArray*)nubArray:(NSArray*)array
+{
+	return nub(array);
+}
+
++(NSArray*)nubWithProjectionBlock:(id(^)(id x))block overArray:(NSArray*)array
+{
+	return nubBy(block, array);
+}
+
++(NSArray*)unionOfArray:(NSArray*)lhsArray withArray:(NSArray*)rhsArray
+{
+	return unionObjects(lhsArray, rhsArray);
+}
+
++(NSArray*)intersectionOfArray:(NSArray*)lhsArray withArray:(NSArray*)rhsArray
+{
+	return intersectObjects(lhsArray, rhsArray);
+}
+
++(NSArray*)differenceOfArray:(NSArray*)lhsArray withArray:(NSArray*)rhsArray
+{
+	return differenceObjects(lhsArray, rhsArray);
+}
+
+-(NSArray*)nubbedArray
+{
+	return nub(self);
+}
+
+-(NSArray*)arrayByNubbingWithProjectionBlock:(id(^)(id x))block
+{
+	return nubBy(block, self);
+}
+
+-(NSArray*)arrayByUnitingWithArray:(NSArray*)array
+{
+	return unionObjects(self, array);
+}
+
+-(NSArray*)arrayByIntersectingWithArray:(NSArray*)array
+{
+	return intersectObjects(self, array);
+}
+
+-(NSArray*)arrayByRemovingObjectsInArray:(NSArray*)array
+{
+	return differenceObjects(self, array);
+}
+
+@end
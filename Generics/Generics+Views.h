@@ -0,0 +1,98 @@
+//
+//  Generics+Views.h
+//  Generics
+//
+//  Copyright (c) 2012 Miso Media. All rights reserved.
+//
+
+#import <Generics/Generics.h>
+
+//!	\file	Materialised views of map, filter and inverseImageArraysByProjectionWithBlock over a mutable source.
+/*!
+	A view owns a reference to a mutable source array and keeps the derived result up to date as the source is edited through the view.
+	Each insertion, removal or replacement evaluates the block only on the objects involved in the delta, never on the whole source.
+	Locating a delta in the result costs O(log n) (O(log^2 n) for inverse image views); the NSMutableArray insertions and removals themselves cost whatever Foundation charges for them.
+	Editing the source behind the view's back leaves the view stale.
+	Views are not thread safe.
+*/
+
+//!	The kinds of change a view reports to its observers.
+typedef enum
+{
+	GenericsViewChangeInsertion,
+	GenericsViewChangeRemoval,
+	GenericsViewChangeReplacement
+} GenericsViewChangeKind;
+
+//!	An observer of an array view.  index is the index in the derived array; oldObject is nil for insertions and newObject is nil for removals.
+typedef void(^GenericsArrayViewObserver)(GenericsViewChangeKind kind, NSUInteger index, id oldObject, id newObject);
+
+//!	An observer of an inverse image view.  index is the index in the array over key; oldObject is nil for insertions and newObject is nil for removals.
+typedef void(^GenericsDictionaryViewObserver)(GenericsViewChangeKind kind, id key, NSUInteger index, id oldObject, id newObject);
+
+//!	The abstract base of all views.
+@interface GenericsView : NSObject
+
+@property(nonatomic, strong, readonly) NSMutableArray* source;	//!<	The source array.  Edit it through the view, not directly.
+
+-(BOOL)insertObject:(id)object atIndex:(NSUInteger)index;	//!<	Inserts object into the source and updates the result.  Returns NO (leaving everything untouched) if the block returns nil for object.
+-(BOOL)addObject:(id)object;	//!<	Appends object to the source and updates the result.
+-(void)removeObjectAtIndex:(NSUInteger)index;	//!<	Removes the object at index from the source and updates the result.
+-(BOOL)replaceObjectAtIndex:(NSUInteger)index withObject:(id)object;	//!<	Replaces the object at index in the source and updates the result.  Returns NO (leaving everything untouched) if the block returns nil for object.
+
+-(void)removeObserver:(id)observer;	//!<	Removes an observer previously returned by addObserverBlock:.
+
+@end
+
+//!	The abstract base of views whose result is an array.
+@interface GenericsArrayView : GenericsView
+
+-(NSArray*)array;	//!<	The current result.  This is live; copy it if you need a snapshot.
+-(id)addObserverBlock:(GenericsArrayViewObserver)block;	//!<	Registers block to be called after every change to the result.  Returns the observer to pass to removeObserver:.
+
+@end
+
+//!	A view of map over a mutable source.
+@interface GenericsMapView : GenericsArrayView
+
+-(id)initWithBlock:(id(^)(id x))function source:(NSMutableArray*)source;	//!<	Returns nil if function returns nil for any object in source.
+
+@end
+
+//!	A view of filter over a mutable source.
+/*!
+	Which source objects satisfy the predicate is kept in an order-statistic tree over source positions, so finding an object's position in the filtrate is O(log n) whatever the pattern of satisfying objects.
+*/
+@interface GenericsFilterView : GenericsArrayView
+
+-(id)initWithBlock:(bool(^)(id x))predicate source:(NSMutableArray*)source;
+
+@end
+
+//!	A view of inverseImageArraysByProjectionWithBlock over a mutable source.
+/*!
+	The projection of each source object is cached, so removals never reevaluate the projection block.
+	Every source object has a node in an order-statistic tree over source positions, and the objects over each key have nodes, in source order, in a tree of their own.
+	A delta touches only the trees of the keys involved, so it costs O(log^2 n) however many keys there are.
+	Arrays which become empty are removed along with their key.
+	Observers are called once the source and the result are both up to date, except when replaceObjectAtIndex:withObject: changes an object's key.
+	Then observers are called between the removal and the insertion: the removal is reported with the new object already in the source but not yet in the array over its new key, and the insertion is reported after it is made.
+	An observer of that removal may edit the view, but must not remove the object being replaced.
+*/
+@interface GenericsInverseImageView : GenericsView
+
+-(id)initWithProjectionBlock:(id(^)(id))projectionBlock source:(NSMutableArray*)source;	//!<	Returns nil if projectionBlock returns nil for any object in source.
+
+-(NSDictionary*)dictionary;	//!<	The current result.  This is live; copy it if you need a snapshot.
+-(id)addObserverBlock:(GenericsDictionaryViewObserver)block;	//!<	Registers block to be called after every change to the result.  Returns the observer to pass to removeObserver:.
+
+@end
+
+//!	Returns a view of map(function, source) which is kept up to date as source is edited through it, or nil if function returns nil for any object in source.
+GenericsMapView* mapView(id(^function)(id x), NSMutableArray* source);
+
+//!	Returns a view of filter(predicate, source) which is kept up to date as source is edited through it.
+GenericsFilterView* filterView(bool(^predicate)(id x), NSMutableArray* source);
+
+//!	Returns a view of inverseImageArraysByProjectionWithBlock(source, projectionBlock) which is kept up to date as source is edited through it, or nil if projectionBlock returns nil for any object in source.
+GenericsInverseImageView* inverseImageArraysViewByProjectionWithBlock(NSMutableArray* source, id(^projectionBlock)(id));
@@ -0,0 +1,413 @@
+//
+//  Generics+Views.m
+//  Generics
+//
+//  Copyright (c) 2012 Miso Media. All rights reserved.
+//
+
+#import "Generics+Views.h"
+#import "GenericsRankTree.h"
+
+#if !__has_feature(objc_arc)
+#error Generics+Views.m must be compiled with ARC (-fobjc-arc).
+#endif
+
+@interface GenericsView()
+
+@property(nonatomic, strong, readwrite) NSMutableArray* source;
+@property(nonatomic, strong) NSMutableArray* observers;
+
+-(id)initWithSource:(NSMutableArray*)source;
+-(void)enumerateObserversUsingBlock:(void(^)(id observer))block;
+
+@end
+
+@implementation GenericsView
+
+@synthesize source;
+@synthesize observers;
+
+-(id)initWithSource:(NSMutableArray*)aSource
+{
+	if((self = [super init]))
+	{
+		source = aSource;
+		observers = [NSMutableArray array];
+	}
+	return self;
+}
+
+-(BOOL)insertObject:(id)object atIndex:(NSUInteger)index
+{
+	[self doesNotRecognizeSelector:_cmd];
+	return NO;
+}
+
+-(BOOL)addObject:(id)object
+{
+	return [self insertObject:object atIndex:[source count]];
+}
+
+-(void)removeObjectAtIndex:(NSUInteger)index
+{
+	[self doesNotRecognizeSelector:_cmd];
+}
+
+-(BOOL)replaceObjectAtIndex:(NSUInteger)index withObject:(id)object
+{
+	[self doesNotRecognizeSelector:_cmd];
+	return NO;
+}
+
+-(void)removeObserver:(id)observer
+{
+	[observers removeObjectIdenticalTo:observer];
+}
+
+//	Observers may remove themselves (or others) while being notified, so enumerate a copy.
+-(void)enumerateObserversUsingBlock:(void(^)(id observer))block
+{
+	if(![observers count])
+		return;
+	for(id observer in [observers copy])
+		block(observer);
+}
+
+@end
+
+@interface GenericsArrayView()
+
+-(void)notifyObserversOfChange:(GenericsViewChangeKind)kind atIndex:(NSUInteger)index oldObject:(id)oldObject newObject:(id)newObject;
+
+@end
+
+@implementation GenericsArrayView
+
+-(NSArray*)array
+{
+	[self doesNotRecognizeSelector:_cmd];
+	return nil;
+}
+
+-(id)addObserverBlock:(GenericsArrayViewObserver)block
+{
+	id observer = [block copy];
+	[self.observers addObject:observer];
+	return observer;
+}
+
+-(void)notifyObserversOfChange:(GenericsViewChangeKind)kind atIndex:(NSUInteger)index oldObject:(id)oldObject newObject:(id)newObject
+{
+	[self enumerateObserversUsingBlock:^(id observer){
+		((GenericsArrayViewObserver)observer)(kind, index, oldObject, newObject);
+	}];
+}
+
+@end
+
+#pragma mark	--map--
+
+@implementation GenericsMapView
+{
+	id(^function)(id x);
+	NSMutableArray* image;
+}
+
+-(id)initWithBlock:(id(^)(id x))aFunction source:(NSMutableArray*)aSource
+{
+	NSArray* initialImage = map(aFunction, aSource);
+	if(!initialImage)
+		return nil;
+	if((self = [super initWithSource:aSource]))
+	{
+		function = [aFunction copy];
+		image = [initialImage mutableCopy];
+	}
+	return self;
+}
+
+-(NSArray*)array
+{
+	return image;
+}
+
+-(BOOL)insertObject:(id)object atIndex:(NSUInteger)index
+{
+	id imageObject = function(object);
+	if(!imageObject)
+		return NO;
+	[self.source insertObject:object atIndex:index];
+	[image insertObject:imageObject atIndex:index];
+	[self notifyObserversOfChange:GenericsViewChangeInsertion atIndex:index oldObject:nil newObject:imageObject];
+	return YES;
+}
+
+-(void)removeObjectAtIndex:(NSUInteger)index
+{
+	id oldImageObject = [image objectAtIndex:index];
+	[self.source removeObjectAtIndex:index];
+	[image removeObjectAtIndex:index];
+	[self notifyObserversOfChange:GenericsViewChangeRemoval atIndex:index oldObject:oldImageObject newObject:nil];
+}
+
+-(BOOL)replaceObjectAtIndex:(NSUInteger)index withObject:(id)object
+{
+	id imageObject = function(object);
+	if(!imageObject)
+		return NO;
+	id oldImageObject = [image objectAtIndex:index];
+	[self.source replaceObjectAtIndex:index withObject:object];
+	[image replaceObjectAtIndex:index withObject:imageObject];
+	[self notifyObserversOfChange:GenericsViewChangeReplacement atIndex:index oldObject:oldImageObject newObject:imageObject];
+	return YES;
+}
+
+@end
+
+#pragma mark	--filter--
+
+@implementation GenericsFilterView
+{
+	bool(^predicate)(id x);
+	GenericsRankTree* positions;	//	one node per source object, marked if it satisfies the predicate
+	NSMutableArray* filtrate;
+}
+
+-(id)initWithBlock:(bool(^)(id x))aPredicate source:(NSMutableArray*)aSource
+{
+	if((self = [super initWithSource:aSource]))
+	{
+		predicate = [aPredicate copy];
+		positions = [[GenericsRankTree alloc] init];
+		filtrate = [NSMutableArray array];
+		for(id object in aSource)
+		{
+			bool satisfies = predicate(object);
+			[positions insertNodeAtIndex:[positions count] marked:satisfies payload:NULL];
+			if(satisfies)
+				[filtrate addObject:object];
+		}
+	}
+	return self;
+}
+
+-(NSArray*)array
+{
+	return filtrate;
+}
+
+-(BOOL)insertObject:(id)object atIndex:(NSUInteger)index
+{
+	bool satisfies = predicate(object);
+	[self.source insertObject:object atIndex:index];
+	[positions insertNodeAtIndex:index marked:satisfies payload:NULL];
+	if(satisfies)
+	{
+		NSUInteger filtrateIndex = [positions markedCountBeforeIndex:index];
+		[filtrate insertObject:object atIndex:filtrateIndex];
+		[self notifyObserversOfChange:GenericsViewChangeInsertion atIndex:filtrateIndex oldObject:nil newObject:object];
+	}
+	return YES;
+}
+
+//	The source is read first so that a bad index raises NSRangeException before it reaches positions, which only asserts.
+-(void)removeObjectAtIndex:(NSUInteger)index
+{
+	id oldObject = [self.source objectAtIndex:index];
+	BOOL satisfied = [positions isMarkedAtIndex:index];
+	NSUInteger filtrateIndex = [positions markedCountBeforeIndex:index];
+	[self.source removeObjectAtIndex:index];
+	[positions removeNodeAtIndex:index];
+	if(satisfied)
+	{
+		[filtrate removeObjectAtIndex:filtrateIndex];
+		[self notifyObserversOfChange:GenericsViewChangeRemoval atIndex:filtrateIndex oldObject:oldObject newObject:nil];
+	}
+}
+
+-(BOOL)replaceObjectAtIndex:(NSUInteger)index withObject:(id)object
+{
+	id oldObject = [self.source objectAtIndex:index];
+	bool satisfies = predicate(object);
+	BOOL satisfied = [positions isMarkedAtIndex:index];
+	NSUInteger filtrateIndex = [positions markedCountBeforeIndex:index];
+	[self.source replaceObjectAtIndex:index withObject:object];
+	[positions setMarked:satisfies atIndex:index];
+	if(satisfied && satisfies)
+	{
+		[filtrate replaceObjectAtIndex:filtrateIndex withObject:object];
+		[self notifyObserversOfChange:GenericsViewChangeReplacement atIndex:filtrateIndex oldObject:oldObject newObject:object];
+	}
+	else if(satisfied)
+	{
+		[filtrate removeObjectAtIndex:filtrateIndex];
+		[self notifyObserversOfChange:GenericsViewChangeRemoval atIndex:filtrateIndex oldObject:oldObject newObject:nil];
+	}
+	else if(satisfies)
+	{
+		[filtrate insertObject:object atIndex:filtrateIndex];
+		[self notifyObserversOfChange:GenericsViewChangeInsertion atIndex:filtrateIndex oldObject:nil newObject:object];
+	}
+	return YES;
+}
+
+@end
+
+#pragma mark	--inverseImageArraysByProjection--
+
+//	Every source object has a node in positions.  The objects over each key also have nodes in that key's tree, in source order, whose payloads are their nodes in positions.
+//	The index of an object in the array over its key is then the number of nodes in the key's tree whose payloads come before the object's source index, which touches no other key.
+@implementation GenericsInverseImageView
+{
+	id(^projectionBlock)(id);
+	NSMutableArray* projections;	//	the projection of each object in the source, in source order
+	GenericsRankTree* positions;
+	NSMutableDictionary* inverseImages;	//	key -> objects in the source with that projection, in source order
+	NSMutableDictionary* inverseImagePositions;	//	key -> GenericsRankTree of the objects in the array over key
+}
+
+-(id)initWithProjectionBlock:(id(^)(id))aProjectionBlock source:(NSMutableArray*)aSource
+{
+	if((self = [super initWithSource:aSource]))
+	{
+		projectionBlock = [aProjectionBlock copy];
+		projections = [NSMutableArray arrayWithCapacity:[aSource count]];
+		positions = [[GenericsRankTree alloc] init];
+		inverseImages = [NSMutableDictionary dictionary];
+		inverseImagePositions = [NSMutableDictionary dictionary];
+		NSUInteger index = 0;
+		for(id object in aSource)
+		{
+			id key = projectionBlock(object);
+			if(!key)
+				return nil;
+			[projections addObject:key];
+			GenericsRankNode* node = [positions insertNodeAtIndex:index marked:NO payload:NULL];
+			[self addObject:object withNode:node atIndex:index toInverseImageOfKey:key notify:NO];
+			++index;
+		}
+	}
+	return self;
+}
+
+-(NSDictionary*)dictionary
+{
+	return inverseImages;
+}
+
+-(id)addObserverBlock:(GenericsDictionaryViewObserver)block
+{
+	id observer = [block copy];
+	[self.observers addObject:observer];
+	return observer;
+}
+
+-(void)notifyObserversOfChange:(GenericsViewChangeKind)kind forKey:(id)key atIndex:(NSUInteger)index oldObject:(id)oldObject newObject:(id)newObject
+{
+	[self enumerateObserversUsingBlock:^(id observer){
+		((GenericsDictionaryViewObserver)observer)(kind, key, index, oldObject, newObject);
+	}];
+}
+
+//	node is the object's node in positions, already at index.
+-(void)addObject:(id)object withNode:(GenericsRankNode*)node atIndex:(NSUInteger)index toInverseImageOfKey:(id)key notify:(BOOL)notify
+{
+	GenericsRankTree* keyPositions = [inverseImagePositions objectForKey:key];
+	NSMutableArray* inverseImage = [inverseImages objectForKey:key];
+	if(!keyPositions)
+	{
+		keyPositions = [[GenericsRankTree alloc] init];
+		inverseImage = [NSMutableArray array];
+		[inverseImagePositions setObject:keyPositions forKey:key];
+		[inverseImages setObject:inverseImage forKey:key];
+	}
+	NSUInteger inverseImageIndex = [keyPositions countOfNodesWithPayloadIndexBelow:index];
+	[keyPositions insertNodeAtIndex:inverseImageIndex marked:NO payload:node];
+	[inverseImage insertObject:object atIndex:inverseImageIndex];
+	if(notify)
+		[self notifyObserversOfChange:GenericsViewChangeInsertion forKey:key atIndex:inverseImageIndex oldObject:nil newObject:object];
+}
+
+//	The object's node must still be in positions, at index.  Returns the index the object had in the array over key; the caller notifies observers once the rest of its state is updated.
+-(NSUInteger)removeIndex:(NSUInteger)index fromInverseImageOfKey:(id)key
+{
+	GenericsRankTree* keyPositions = [inverseImagePositions objectForKey:key];
+	NSMutableArray* inverseImage = [inverseImages objectForKey:key];
+	NSUInteger inverseImageIndex = [keyPositions countOfNodesWithPayloadIndexBelow:index];
+	[keyPositions removeNodeAtIndex:inverseImageIndex];
+	[inverseImage removeObjectAtIndex:inverseImageIndex];
+	if(![inverseImage count])
+	{
+		[inverseImagePositions removeObjectForKey:key];
+		[inverseImages removeObjectForKey:key];
+	}
+	return inverseImageIndex;
+}
+
+-(BOOL)insertObject:(id)object atIndex:(NSUInteger)index
+{
+	id key = projectionBlock(object);
+	if(!key)
+		return NO;
+	[self.source insertObject:object atIndex:index];
+	[projections insertObject:key atIndex:index];
+	GenericsRankNode* node = [positions insertNodeAtIndex:index marked:NO payload:NULL];
+	[self addObject:object withNode:node atIndex:index toInverseImageOfKey:key notify:YES];
+	return YES;
+}
+
+-(void)removeObjectAtIndex:(NSUInteger)index
+{
+	id key = [projections objectAtIndex:index];
+	id oldObject = [self.source objectAtIndex:index];
+	NSUInteger inverseImageIndex = [self removeIndex:index fromInverseImageOfKey:key];
+	[self.source removeObjectAtIndex:index];
+	[projections removeObjectAtIndex:index];
+	[positions removeNodeAtIndex:index];
+	[self notifyObserversOfChange:GenericsViewChangeRemoval forKey:key atIndex:inverseImageIndex oldObject:oldObject newObject:nil];
+}
+
+-(BOOL)replaceObjectAtIndex:(NSUInteger)index withObject:(id)object
+{
+	id key = projectionBlock(object);
+	if(!key)
+		return NO;
+	id oldKey = [projections objectAtIndex:index];
+	id oldObject = [self.source objectAtIndex:index];
+	[self.source replaceObjectAtIndex:index withObject:object];
+	if([oldKey isEqual:key])
+	{
+		NSMutableArray* inverseImage = [inverseImages objectForKey:key];
+		NSUInteger inverseImageIndex = [[inverseImagePositions objectForKey:key] countOfNodesWithPayloadIndexBelow:index];
+		[inverseImage replaceObjectAtIndex:inverseImageIndex withObject:object];
+		[self notifyObserversOfChange:GenericsViewChangeReplacement forKey:key atIndex:inverseImageIndex oldObject:oldObject newObject:object];
+	}
+	else
+	{
+		//	Observers hear of the removal with the object in the source but in no array, and of the insertion once it is over the new key.
+		//	Its index is recomputed from its node after the removal is reported, in case an observer shifted it.
+		GenericsRankNode* node = [positions nodeAtIndex:index];
+		[projections replaceObjectAtIndex:index withObject:key];
+		NSUInteger inverseImageIndex = [self removeIndex:index fromInverseImageOfKey:oldKey];
+		[self notifyObserversOfChange:GenericsViewChangeRemoval forKey:oldKey atIndex:inverseImageIndex oldObject:oldObject newObject:nil];
+		[self addObject:object withNode:node atIndex:GenericsRankNodeIndex(node) toInverseImageOfKey:key notify:YES];
+	}
+	return YES;
+}
+
+@end
+
+GenericsMapView* mapView(id(^function)(id x), NSMutableArray* source)
+{
+	return [[GenericsMapView alloc] initWithBlock:function source:source];
+}
+
+GenericsFilterView* filterView(bool(^predicate)(id x), NSMutableArray* source)
+{
+	return [[GenericsFilterView alloc] initWithBlock:predicate source:source];
+}
+
+GenericsInverseImageView* inverseImageArraysViewByProjectionWithBlock(NSMutableArray* source, id(^projectionBlock)(id))
+{
+	return [[GenericsInverseImageView alloc] initWithProjectionBlock:projectionBlock source:source];
+}
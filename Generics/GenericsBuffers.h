@@ -0,0 +1,25 @@
+//
+//  GenericsBuffers.h
+//  Generics
+//
+//  Copyright (c) 2012 Miso Media. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+//!	\file	GenericsBuffers.h has the internal C buffers the concurrent generics write their results into by index.
+
+//!	Returns a zeroed buffer of count strong references.  Release it with freeResultsBuffer or arrayByConsumingResultsBuffer.
+__strong id* newResultsBuffer(NSUInteger count);
+
+//!	Releases every reference in results and frees it.
+void freeResultsBuffer(__strong id* results, NSUInteger count);
+
+//!	Returns an array of the objects in results (or nil if failed is set) and frees results.
+NSArray* arrayByConsumingResultsBuffer(__strong id* results, NSUInteger count, BOOL failed);
+
+//!	Returns a malloced buffer of the objects of list, with extra (if not nil) in front of them or behind them, and sets *outCount to its length.
+/*!
+	The objects are not retained; list (and extra) must outlive the buffer.  Free it with free.
+*/
+__unsafe_unretained id* newObjectsBuffer(NSArray* list, id extra, BOOL extraInFront, NSUInteger* outCount);
@@ -0,0 +1,45 @@
+//
+//  GenericsBuffers.m
+//  Generics
+//
+//  Copyright (c) 2012 Miso Media. All rights reserved.
+//
+
+#import "GenericsBuffers.h"
+
+#if !__has_feature(objc_arc)
+#error GenericsBuffers.m must be compiled with ARC (-fobjc-arc).
+#endif
+
+__strong id* newResultsBuffer(NSUInteger count)
+{
+	return (__strong id*)calloc(count ? count : 1, sizeof(id));
+}
+
+void freeResultsBuffer(__strong id* results, NSUInteger count)
+{
+	for(NSUInteger i = 0; i < count; ++i)
+		results[i] = nil;
+	free(results);
+}
+
+NSArray* arrayByConsumingResultsBuffer(__strong id* results, NSUInteger count, BOOL failed)
+{
+	NSArray* array = failed ? nil : [NSArray arrayWithObjects:results count:count];
+	freeResultsBuffer(results, count);
+	return array;
+}
+
+__unsafe_unretained id* newObjectsBuffer(NSArray* list, id extra, BOOL extraInFront, NSUInteger* outCount)
+{
+	NSUInteger listCount = [list count];
+	NSUInteger count = listCount + (extra ? 1 : 0);
+	__unsafe_unretained id* objects = (__unsafe_unretained id*)malloc((count ? count : 1) * sizeof(id));
+	NSUInteger offset = (extra && extraInFront) ? 1 : 0;
+	if(listCount)
+		[list getObjects:objects + offset range:NSMakeRange(0, listCount)];
+	if(extra)
+		objects[extraInFront ? 0 : listCount] = extra;
+	*outCount = count;
+	return objects;
+}
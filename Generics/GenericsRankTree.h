@@ -0,0 +1,38 @@
+//
+//  GenericsRankTree.h
+//  Generics
+//
+//  Copyright (c) 2012 Miso Media. All rights reserved.
+//
+
+#import <Foundation/Foundation.h>
+
+//!	\file	GenericsRankTree.h is an internal order-statistic tree used by the views.
+
+typedef struct GenericsRankNode GenericsRankNode;
+
+//!	The index of node in the tree which holds it, in O(log n).
+NSUInteger GenericsRankNodeIndex(GenericsRankNode* node);
+
+//!	A sequence of nodes, each optionally marked and optionally carrying a payload, supporting positional insertion, removal and rank queries in O(log n).
+/*!
+	It is a treap keyed implicitly by position, with each subtree recording its size and its number of marked nodes.
+	Nodes also record their parents, so GenericsRankNodeIndex can find a node's index from the node alone.
+	Nodes stay put (and so pointers to them stay valid) until they are removed.
+*/
+@interface GenericsRankTree : NSObject
+
+-(NSUInteger)count;
+
+-(GenericsRankNode*)insertNodeAtIndex:(NSUInteger)index marked:(BOOL)marked payload:(void*)payload;	//!<	Returns the new node.
+-(void)removeNodeAtIndex:(NSUInteger)index;
+-(GenericsRankNode*)nodeAtIndex:(NSUInteger)index;
+
+-(BOOL)isMarkedAtIndex:(NSUInteger)index;
+-(void)setMarked:(BOOL)marked atIndex:(NSUInteger)index;
+-(NSUInteger)markedCountBeforeIndex:(NSUInteger)index;	//!<	The number of marked nodes before index.
+
+//!	Assuming every payload is a node of some other tree and that the payloads are in the same order as they are in that tree, the number of nodes whose payload's index is less than index.  O(log^2 n).
+-(NSUInteger)countOfNodesWithPayloadIndexBelow:(NSUInteger)index;
+
+@end
@@ -0,0 +1,222 @@
+//
+//  GenericsRankTree.m
+//  Generics
+//
+//  Copyright (c) 2012 Miso Media. All rights reserved.
+//
+
+#import "GenericsRankTree.h"
+
+#if !__has_feature(objc_arc)
+#error GenericsRankTree.m must be compiled with ARC (-fobjc-arc).
+#endif
+
+struct GenericsRankNode
+{
+	GenericsRankNode* children[2];
+	GenericsRankNode* parent;
+	void* payload;
+	NSUInteger size;
+	NSUInteger markedCount;
+	uint32_t priority;
+	bool marked;
+};
+
+static NSUInteger sizeOfNode(GenericsRankNode* node)
+{
+	return node ? node->size : 0;
+}
+
+static NSUInteger markedCountOfNode(GenericsRankNode* node)
+{
+	return node ? node->markedCount : 0;
+}
+
+//	Recomputes node's totals from its children and points the children back at it.
+static void updateNode(GenericsRankNode* node)
+{
+	node->size = 1 + sizeOfNode(node->children[0]) + sizeOfNode(node->children[1]);
+	node->markedCount = (node->marked ? 1 : 0) + markedCountOfNode(node->children[0]) + markedCountOfNode(node->children[1]);
+	for(int side = 0; side < 2; ++side)
+		if(node->children[side])
+			node->children[side]->parent = node;
+}
+
+//	Splits the tree at node into its first index nodes and the rest.  The parents of the two roots are left for the caller to fix.
+static void splitNode(GenericsRankNode* node, NSUInteger index, GenericsRankNode** lhs, GenericsRankNode** rhs)
+{
+	if(!node)
+	{
+		*lhs = *rhs = NULL;
+		return;
+	}
+	NSUInteger leftSize = sizeOfNode(node->children[0]);
+	if(index <= leftSize)
+	{
+		splitNode(node->children[0], index, lhs, &node->children[0]);
+		updateNode(node);
+		*rhs = node;
+	}
+	else
+	{
+		splitNode(node->children[1], index - leftSize - 1, &node->children[1], rhs);
+		updateNode(node);
+		*lhs = node;
+	}
+}
+
+static GenericsRankNode* mergeNodes(GenericsRankNode* lhs, GenericsRankNode* rhs)
+{
+	if(!lhs)
+		return rhs;
+	if(!rhs)
+		return lhs;
+	if(lhs->priority > rhs->priority)
+	{
+		lhs->children[1] = mergeNodes(lhs->children[1], rhs);
+		updateNode(lhs);
+		return lhs;
+	}
+	rhs->children[0] = mergeNodes(lhs, rhs->children[0]);
+	updateNode(rhs);
+	return rhs;
+}
+
+static void freeNodes(GenericsRankNode* node)
+{
+	if(!node)
+		return;
+	freeNodes(node->children[0]);
+	freeNodes(node->children[1]);
+	free(node);
+}
+
+NSUInteger GenericsRankNodeIndex(GenericsRankNode* node)
+{
+	NSUInteger index = sizeOfNode(node->children[0]);
+	for(; node->parent; node = node->parent)
+		if(node == node->parent->children[1])
+			index += sizeOfNode(node->parent->children[0]) + 1;
+	return index;
+}
+
+@implementation GenericsRankTree
+{
+	GenericsRankNode* root;
+}
+
+-(void)dealloc
+{
+	freeNodes(root);
+}
+
+-(void)setRoot:(GenericsRankNode*)node
+{
+	root = node;
+	if(root)
+		root->parent = NULL;
+}
+
+-(NSUInteger)count
+{
+	return sizeOfNode(root);
+}
+
+-(GenericsRankNode*)insertNodeAtIndex:(NSUInteger)index marked:(BOOL)marked payload:(void*)payload
+{
+	NSParameterAssert(index <= sizeOfNode(root));
+	GenericsRankNode* node = (GenericsRankNode*)calloc(1, sizeof(GenericsRankNode));
+	node->payload = payload;
+	node->priority = arc4random();
+	node->marked = marked;
+	updateNode(node);
+	GenericsRankNode* lhs;
+	GenericsRankNode* rhs;
+	splitNode(root, index, &lhs, &rhs);
+	[self setRoot:mergeNodes(mergeNodes(lhs, node), rhs)];
+	return node;
+}
+
+-(void)removeNodeAtIndex:(NSUInteger)index
+{
+	NSParameterAssert(index < sizeOfNode(root));
+	GenericsRankNode* lhs;
+	GenericsRankNode* middle;
+	GenericsRankNode* rhs;
+	splitNode(root, index, &lhs, &rhs);
+	splitNode(rhs, 1, &middle, &rhs);
+	[self setRoot:mergeNodes(lhs, rhs)];
+	free(middle);
+}
+
+-(GenericsRankNode*)nodeAtIndex:(NSUInteger)index
+{
+	NSParameterAssert(index < sizeOfNode(root));
+	GenericsRankNode* node = root;
+	for(;;)
+	{
+		NSUInteger leftSize = sizeOfNode(node->children[0]);
+		if(index == leftSize)
+			return node;
+		if(index < leftSize)
+			node = node->children[0];
+		else
+		{
+			index -= leftSize + 1;
+			node = node->children[1];
+		}
+	}
+}
+
+-(BOOL)isMarkedAtIndex:(NSUInteger)index
+{
+	return [self nodeAtIndex:index]->marked;
+}
+
+-(void)setMarked:(BOOL)marked atIndex:(NSUInteger)index
+{
+	GenericsRankNode* node = [self nodeAtIndex:index];
+	if(node->marked == (bool)marked)
+		return;
+	node->marked = marked;
+	for(; node; node = node->parent)
+		updateNode(node);
+}
+
+-(NSUInteger)markedCountBeforeIndex:(NSUInteger)index
+{
+	NSUInteger markedCount = 0;
+	GenericsRankNode* node = root;
+	while(node)
+	{
+		NSUInteger leftSize = sizeOfNode(node->children[0]);
+		if(index <= leftSize)
+			node = node->children[0];
+		else
+		{
+			markedCount += markedCountOfNode(node->children[0]) + (node->marked ? 1 : 0);
+			index -= leftSize + 1;
+			node = node->children[1];
+		}
+	}
+	return markedCount;
+}
+
+-(NSUInteger)countOfNodesWithPayloadIndexBelow:(NSUInteger)index
+{
+	NSUInteger count = 0;
+	GenericsRankNode* node = root;
+	while(node)
+	{
+		if(GenericsRankNodeIndex((GenericsRankNode*)node->payload) < index)
+		{
+			count += sizeOfNode(node->children[0]) + 1;
+			node = node->children[1];
+		}
+		else
+			node = node->children[0];
+	}
+	return count;
+}
+
+@end